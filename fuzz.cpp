@@ -0,0 +1,876 @@
+/**
+ * Differential fuzzer of all the ways to get tokens.
+ *
+ * Every case makes a grammar (random comments, keywords and symbols, or
+ * one of the compile-time specs below) and a source of it, and checks
+ * every mode gives the same tokens as the reference, which is the raw
+ * stream of 'sclexer_get_tok' filtered by a trivial 'filter'.
+ * Kinds, payloads, source slices and locations are all compared.
+ * 'sclexer_estimate_tokens' is checked to be an upper bound of every kind,
+ * for the grammars its doc promises so.
+ *
+ * Standalone: './fuzz [iterations] [seed]', case 'i' uses seed 'seed + i',
+ * so a failure can be replayed by './fuzz 1 <seed of the case>'.
+ * It prints throughput of each mode, timed from a ready lexer to the last
+ * token, so setup (configs, 'sclexer_init' and constructors) is excluded,
+ * but the reset modes time the reset too, as it's what they are about.
+ * libFuzzer:  build with 'SCLEXER_LIBFUZZER', the input drives all choices,
+ * throughput is not reported, replay a failure by the crashing input.
+ *
+ * Sources are always lexable, because the reference exits on unknown
+ * tokens: every char of symbols and comments is also a symbol, so the
+ * rest of a greedily matched symbol is still a token.
+ */
+#include "sclexer.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+enum MODE {
+	MODE_REFERENCE,
+	MODE_GET_TOKENS,
+	MODE_RESET,
+	MODE_SKIP,
+	MODE_CPP,
+	MODE_CPP_RESET,
+	MODE_SPEC,
+	MODE_SPEC_RESET,
+
+	MODE_COUNT
+};
+
+static const char *mode_names[MODE_COUNT] = {
+	"reference (sclexer_get_tok)",
+	"sclexer_get_tokens",
+	"sclexer_reset",
+	"skip_kinds",
+	"scl::Lexer<>",
+	"scl::Lexer<>::reset",
+	"scl::Lexer<Spec>",
+	"scl::Lexer<Spec>::reset"
+};
+
+struct throughput {
+	double seconds;
+	size_t bytes;
+	size_t tokens;
+	size_t runs;
+};
+
+static throughput modes[MODE_COUNT];
+static const char *fpath = "fuzz";
+/* Which case failed, for messages. */
+#ifdef SCLEXER_LIBFUZZER
+static const char *case_name()
+{
+	return "libFuzzer input";
+}
+#else
+static uint64_t cur_seed;
+
+static const char *case_name()
+{
+	static char name[32];
+	std::snprintf(name, sizeof(name), "seed %llu",
+			(unsigned long long)cur_seed);
+	return name;
+}
+#endif
+
+/* Random numbers from a seed, or bytes from libFuzzer. */
+class entropy {
+public:
+	explicit entropy(uint64_t seed) : rng_(seed) {}
+	entropy(const uint8_t *data, size_t size) : data_(data), size_(size) {}
+
+	/* [0, n) */
+	uint32_t next(uint32_t n)
+	{
+		uint32_t v = 0;
+		if (n == 0)
+			return 0;
+		if (!data_)
+			return rng_() % n;
+		for (int i = 0; i < 2 && pos_ < size_; i++)
+			v = v << 8 | data_[pos_++];
+		return v % n;
+	}
+
+	bool chance(uint32_t percent) { return next(100) < percent; }
+
+	char pick(const char *chars) { return chars[next(std::strlen(chars))]; }
+
+private:
+	std::mt19937_64 rng_;
+	const uint8_t *data_ = nullptr;
+	size_t size_ = 0, pos_ = 0;
+};
+
+struct grammar {
+	std::vector<std::string> comments, keywords, symbols;
+	bool enable_indent = false;
+
+	/* point to strings above, setup by 'finish' */
+	std::vector<const char *> c_comments, c_keywords, c_symbols;
+
+	void finish()
+	{
+		to_cstrs(c_comments, comments);
+		to_cstrs(c_keywords, keywords);
+		to_cstrs(c_symbols, symbols);
+	}
+
+	scl::options options(uint32_t skip_kinds, bool keep_dup_eol) const
+	{
+		scl::options opts;
+		opts.comments = comments;
+		opts.keywords = keywords;
+		opts.symbols = symbols;
+		opts.enable_indent = enable_indent;
+		opts.skip_kinds = skip_kinds;
+		opts.keep_dup_eol = keep_dup_eol;
+		return opts;
+	}
+
+	sclexer_config config(uint32_t skip_kinds, bool keep_dup_eol)
+	{
+		sclexer_config cfg{};
+		cfg.enable_indent = enable_indent;
+		cfg.comments = c_comments.data();
+		cfg.comments_count = c_comments.size();
+		cfg.keywords = c_keywords.data();
+		cfg.keywords_count = c_keywords.size();
+		cfg.symbols = c_symbols.data();
+		cfg.symbols_count = c_symbols.size();
+		cfg.skip_kinds = skip_kinds;
+		cfg.keep_dup_eol = keep_dup_eol;
+		sclexer_config_init(&cfg);
+		return cfg;
+	}
+
+private:
+	static void to_cstrs(std::vector<const char *> &dst,
+			const std::vector<std::string> &src)
+	{
+		dst.clear();
+		for (const std::string &s : src)
+			dst.push_back(s.c_str());
+	}
+};
+
+/* Token without pointers, so tokens of different buffers can be compared. */
+struct norm_tok {
+	SCLEXER_TOK_KIND kind;
+	uint64_t data;
+	size_t data_off, data_len;
+	size_t off, len;
+	size_t line, column;
+	bool fpath_ok;
+
+	bool operator==(const norm_tok &) const = default;
+};
+
+static norm_tok normalize(const sclexer_tok &tok, const char *src)
+{
+	norm_tok n{};
+	n.kind = tok.kind;
+	switch (tok.kind) {
+	case SCLEXER_INT:
+	case SCLEXER_INT_NEG:
+		n.data = tok.data.uint;
+		break;
+	case SCLEXER_KEYWORD:
+		n.data = tok.data.keyword;
+		break;
+	case SCLEXER_SYMBOL:
+		n.data = tok.data.symbol;
+		break;
+	case SCLEXER_IDENT:
+	case SCLEXER_STRING:
+		n.data_off = tok.data.str.begin - src;
+		n.data_len = tok.data.str.len;
+		break;
+	default:
+		break;
+	}
+	n.off = tok.src.begin - src;
+	n.len = tok.src.len;
+	n.line = tok.loc.line;
+	n.column = tok.loc.column;
+	n.fpath_ok = tok.loc.fpath && std::strcmp(tok.loc.fpath, fpath) == 0;
+	return n;
+}
+
+static std::vector<norm_tok> normalize_all(const sclexer_tok *tokens,
+		size_t count,
+		const char *src)
+{
+	std::vector<norm_tok> result;
+	result.reserve(count);
+	for (size_t i = 0; i < count; i++)
+		result.push_back(normalize(tokens[i], src));
+	return result;
+}
+
+/* What 'skip_kinds' and EOL coalescing must do to the raw stream. */
+static std::vector<norm_tok> filter(const std::vector<norm_tok> &raw,
+		uint32_t skip_kinds,
+		bool keep_dup_eol)
+{
+	std::vector<norm_tok> result;
+	SCLEXER_TOK_KIND prev = SCLEXER_UNKNOWN_TOK;
+	for (const norm_tok &tok : raw) {
+		if (skip_kinds & SCLEXER_KIND_BIT(tok.kind))
+			continue;
+		if (!keep_dup_eol && tok.kind == SCLEXER_EOL && prev == SCLEXER_EOL)
+			continue;
+		prev = tok.kind;
+		result.push_back(tok);
+	}
+	return result;
+}
+
+class timer {
+public:
+	explicit timer(MODE mode) : mode_(mode), begin_(clock::now()) {}
+
+	void stop(size_t bytes, size_t tokens)
+	{
+		std::chrono::duration<double> d = clock::now() - begin_;
+		modes[mode_].seconds += d.count();
+		modes[mode_].bytes += bytes;
+		modes[mode_].tokens += tokens;
+		modes[mode_].runs++;
+	}
+
+private:
+	using clock = std::chrono::steady_clock;
+	MODE mode_;
+	clock::time_point begin_;
+};
+
+static void print_escaped(const std::string &s)
+{
+	for (char c : s) {
+		switch (c) {
+		case '\n': std::fputs("\\n", stderr); break;
+		case '\t': std::fputs("\\t", stderr); break;
+		case '\\': std::fputs("\\\\", stderr); break;
+		default:   std::fputc(c, stderr); break;
+		}
+	}
+}
+
+static void print_list(const char *name, const std::vector<std::string> &list)
+{
+	std::fprintf(stderr, "%s:", name);
+	for (const std::string &s : list) {
+		std::fputs(" '", stderr);
+		print_escaped(s);
+		std::fputc('\'', stderr);
+	}
+	std::fputc('\n', stderr);
+}
+
+static void print_norm_tok(const char *name, const norm_tok *tok)
+{
+	if (!tok) {
+		std::fprintf(stderr, "  %s: none\n", name);
+		return;
+	}
+	std::fprintf(stderr, "  %s: %s data=%llu str=%zu+%zu src=%zu+%zu "
+			"l:%zu,c:%zu fpath=%s\n",
+			name, sclexer_kind_names(tok->kind),
+			(unsigned long long)tok->data,
+			tok->data_off, tok->data_len,
+			tok->off, tok->len,
+			tok->line, tok->column,
+			tok->fpath_ok ? "ok" : "bad");
+}
+
+static void print_case(const grammar &g, const std::string &src)
+{
+	print_list("comments", g.comments);
+	print_list("keywords", g.keywords);
+	print_list("symbols", g.symbols);
+	std::fprintf(stderr, "enable_indent: %d\nsource: '", g.enable_indent);
+	print_escaped(src);
+	std::fputs("'\n", stderr);
+}
+
+static void check(MODE mode,
+		const char *what,
+		const grammar &g,
+		const std::string &src,
+		const std::vector<norm_tok> &expected,
+		const std::vector<norm_tok> &got)
+{
+	size_t i = 0;
+	for (; i < expected.size() && i < got.size(); i++) {
+		if (!(expected[i] == got[i]))
+			break;
+	}
+	if (i == expected.size() && i == got.size())
+		return;
+
+	std::fprintf(stderr, "fuzz: mode '%s' (%s) differs at token %zu, %s\n",
+			mode_names[mode], what, i, case_name());
+	print_case(g, src);
+	print_norm_tok("expected", i < expected.size() ? &expected[i] : nullptr);
+	print_norm_tok("got", i < got.size() ? &got[i] : nullptr);
+	std::abort();
+}
+
+static void print_stats_diff(const char *a_name, const sclexer_stats &a,
+		const char *b_name, const sclexer_stats &b)
+{
+	for (int kind = 0; kind < SCLEXER_TOK_KIND_COUNT; kind++) {
+		std::fprintf(stderr, "  %s: %s %zu, %s %zu\n",
+				sclexer_kind_names((SCLEXER_TOK_KIND)kind),
+				a_name, a.kinds[kind], b_name, b.kinds[kind]);
+	}
+	std::fprintf(stderr, "  tokens: %s %zu, %s %zu\n",
+			a_name, a.tokens, b_name, b.tokens);
+	std::fprintf(stderr, "  bytes: %s %zu, %s %zu\n",
+			a_name, a.bytes, b_name, b.bytes);
+}
+
+static void check_stats(MODE mode,
+		const grammar &g,
+		const std::string &src,
+		const sclexer_stats &stats,
+		const std::vector<norm_tok> &expected)
+{
+	sclexer_stats want{};
+	for (const norm_tok &tok : expected)
+		want.kinds[tok.kind]++;
+	want.tokens = expected.size();
+	/* source to the end of the last returned token */
+	if (!expected.empty())
+		want.bytes = expected.back().off + expected.back().len;
+	if (want.tokens == stats.tokens
+			&& want.bytes == stats.bytes
+			&& std::memcmp(want.kinds, stats.kinds, sizeof(want.kinds)) == 0)
+		return;
+
+	std::fprintf(stderr, "fuzz: mode '%s' (stats) differs, %s\n",
+			mode_names[mode], case_name());
+	print_case(g, src);
+	print_stats_diff("expected", want, "got", stats);
+	std::abort();
+}
+
+/*
+ * 'sclexer_estimate_tokens' over counts symbols and EOL, it is only exact
+ * enough to be a bound when no symbol begins with an identifier char and
+ * no comment begins inside a symbol.
+ */
+static bool estimate_is_bound(const grammar &g)
+{
+	for (const std::string &sym : g.symbols) {
+		if (sclexer_default_is_ident(sym[0], false))
+			return false;
+		for (const std::string &comment : g.comments) {
+			if (sym.find(comment[0], 1) != std::string::npos)
+				return false;
+		}
+	}
+	return true;
+}
+
+/* 'skip_kinds' and 'keep_dup_eol' set on a lexer instead of its config. */
+struct mask {
+	uint32_t skip_kinds;
+	bool keep_dup_eol;
+};
+
+static void init_lexer(sclexer &lexer,
+		const sclexer_config *cfg,
+		const mask *m,
+		const std::string &src)
+{
+	lexer.cfg = cfg;
+	lexer.src = src.c_str();
+	lexer.src_siz = src.size();
+	sclexer_init(&lexer, fpath);
+	if (!m)
+		return;
+	lexer.skip_kinds = m->skip_kinds;
+	lexer.keep_dup_eol = m->keep_dup_eol;
+}
+
+static void check_estimate(const grammar &g,
+		const sclexer_config *cfg,
+		const mask *m,
+		const std::string &src,
+		const sclexer_stats &stats)
+{
+	sclexer_stats estimated;
+	sclexer lexer{};
+	init_lexer(lexer, cfg, m, src);
+	sclexer_estimate_tokens(&lexer, &estimated);
+
+	int kind = 0;
+	for (; kind < SCLEXER_TOK_KIND_COUNT; kind++) {
+		if (estimated.kinds[kind] < stats.kinds[kind])
+			break;
+	}
+	if (kind == SCLEXER_TOK_KIND_COUNT && estimated.tokens >= stats.tokens)
+		return;
+
+	std::fprintf(stderr, "fuzz: estimate is under actual, %s\n",
+			case_name());
+	print_case(g, src);
+	std::fprintf(stderr, "skip_kinds: %#x\n", (unsigned)lexer.skip_kinds);
+	print_stats_diff("estimated", estimated, "actual", stats);
+	std::abort();
+}
+
+static std::vector<norm_tok> lex_stream(MODE mode,
+		const sclexer_config *cfg,
+		const mask *m,
+		const std::string &src,
+		sclexer_stats *stats)
+{
+	std::vector<sclexer_tok> tokens;
+	sclexer_tok tok{};
+	sclexer lexer{};
+	tokens.reserve(src.size() / 2 + 4);
+
+	init_lexer(lexer, cfg, m, src);
+	timer t(mode);
+	while (sclexer_get_tok(&lexer, &tok))
+		tokens.push_back(tok);
+	t.stop(src.size(), tokens.size());
+
+	if (stats)
+		*stats = lexer.stats;
+	return normalize_all(tokens.data(), tokens.size(), src.c_str());
+}
+
+/* Compile-time specs, keep every char of symbols and comments a symbol. */
+struct lisp_spec {
+	static constexpr std::array comments{";"};
+	static constexpr std::array keywords{"print", "define", "if", "if"};
+	static constexpr std::array symbols{"(", ")", "+", "+=", "-", "=", "'", ";"};
+	static constexpr bool enable_indent = true;
+};
+
+struct c_spec {
+	static constexpr std::array comments{"//", "#"};
+	static constexpr std::array keywords{"int", "if", "else", "return", "i"};
+	static constexpr std::array symbols{
+		"{", "}", "(", ")", ";", ",", "=", "==", "!", "!=",
+		"<", "<=", "<<", "<<=", ">", ">=", ">>", "+", "++", "+=",
+		"-", "--", "->", "*", "/", "&", "&&", "|", "||", "#"
+	};
+};
+
+struct skip_spec {
+	static constexpr std::array comments{"--"};
+	static constexpr std::array keywords{"do", "end"};
+	static constexpr std::array symbols{"-", ":", "::", ":=", "="};
+	static constexpr bool enable_indent = true;
+	static constexpr uint32_t skip_kinds =
+		SCLEXER_KIND_BIT(SCLEXER_IDENT)
+		| SCLEXER_KIND_BIT(SCLEXER_INDENT_BLOCK_END);
+	static constexpr bool keep_dup_eol = true;
+};
+
+struct empty_spec {
+	static constexpr std::array<const char *, 0> comments{};
+	static constexpr std::array<const char *, 0> keywords{};
+	static constexpr std::array symbols{"@"};
+};
+
+template <typename Spec>
+static grammar spec_grammar()
+{
+	grammar g;
+	g.comments.assign(Spec::comments.begin(), Spec::comments.end());
+	g.keywords.assign(Spec::keywords.begin(), Spec::keywords.end());
+	g.symbols.assign(Spec::symbols.begin(), Spec::symbols.end());
+	g.enable_indent = scl::Lexer<Spec>::enable_indent;
+	return g;
+}
+
+template <typename Spec>
+static std::vector<norm_tok> lex_spec(const std::string &src,
+		sclexer_stats *stats)
+{
+	scl::Lexer<Spec> lexer(src, fpath);
+	std::vector<sclexer_tok> tokens;
+	tokens.reserve(src.size() / 2 + 4);
+
+	timer t(MODE_SPEC);
+	for (const sclexer_tok &tok : lexer)
+		tokens.push_back(tok);
+	t.stop(src.size(), tokens.size());
+
+	*stats = lexer.stats();
+	return normalize_all(tokens.data(), tokens.size(), lexer.get()->src);
+}
+
+/* Skip 'n' tokens, at most. */
+template <typename L>
+static void lex_some(L &lexer, size_t n)
+{
+	for (auto it = lexer.begin(); n && it != lexer.end(); n--)
+		++it;
+}
+
+/*
+ * Lex 'n' tokens of previous source, or of ' ' + 'src' when 'from_self',
+ * then 'reset' resets to a view of 'src' in the lexer itself,
+ * which overlaps the place it's copied to.
+ */
+template <typename L>
+static void before_reset(L &lexer, size_t n, bool from_self,
+		const std::string &src)
+{
+	lex_some(lexer, n);
+	if (!from_self)
+		return;
+	lexer.reset(' ' + src, fpath);
+	lex_some(lexer, n);
+}
+
+template <typename L>
+static void reset(L &lexer, bool from_self, const std::string &src)
+{
+	if (!from_self) {
+		lexer.reset(src, fpath);
+		return;
+	}
+	lexer.reset(std::string_view(lexer.get()->src + 1, src.size()),
+			lexer.get()->_loc.fpath);
+}
+
+template <typename Spec>
+static std::vector<norm_tok> lex_spec_reset(const std::string &prev,
+		size_t n,
+		bool from_self,
+		const std::string &src,
+		sclexer_stats *stats)
+{
+	scl::Lexer<Spec> lexer(prev, "prev");
+	std::vector<sclexer_tok> tokens;
+	tokens.reserve(src.size() / 2 + 4);
+
+	before_reset(lexer, n, from_self, src);
+
+	timer t(MODE_SPEC_RESET);
+	reset(lexer, from_self, src);
+	for (const sclexer_tok &tok : lexer)
+		tokens.push_back(tok);
+	t.stop(src.size(), tokens.size());
+
+	*stats = lexer.stats();
+	return normalize_all(tokens.data(), tokens.size(), lexer.get()->src);
+}
+
+struct spec_case {
+	grammar (*make)();
+	std::vector<norm_tok> (*lex)(const std::string &src,
+			sclexer_stats *stats);
+	std::vector<norm_tok> (*lex_reset)(const std::string &prev,
+			size_t n,
+			bool from_self,
+			const std::string &src,
+			sclexer_stats *stats);
+	uint32_t skip_kinds;
+	bool keep_dup_eol;
+};
+
+template <typename Spec>
+static constexpr spec_case make_spec_case()
+{
+	return {
+		spec_grammar<Spec>,
+		lex_spec<Spec>,
+		lex_spec_reset<Spec>,
+		scl::Lexer<Spec>::skip_kinds,
+		scl::Lexer<Spec>::keep_dup_eol
+	};
+}
+
+static const spec_case spec_cases[] = {
+	make_spec_case<lisp_spec>(),
+	make_spec_case<c_spec>(),
+	make_spec_case<skip_spec>(),
+	make_spec_case<empty_spec>()
+};
+
+static const char symbol_chars[] = "()[]{}<>+-*/%=!&|^~,.:;#@$?'";
+static const char ident_begin_chars[] = "abcdeXY_";
+static const char ident_chars[] = "abcdeXY_0123456789";
+
+static std::string random_str(entropy &e, const char *begin, const char *rest,
+		size_t max_len)
+{
+	std::string s(1, e.pick(begin));
+	size_t len = e.next(max_len);
+	for (size_t i = 0; i < len; i++)
+		s += e.pick(rest);
+	return s;
+}
+
+static void add_symbol(grammar &g, const std::string &sym)
+{
+	for (const std::string &s : g.symbols) {
+		if (s == sym)
+			return;
+	}
+	g.symbols.push_back(sym);
+}
+
+static grammar random_grammar(entropy &e)
+{
+	static const char *common_comments[] = {";", "//", "#", "--", "%"};
+	grammar g;
+	size_t n = e.next(3);
+	for (size_t i = 0; i < n; i++) {
+		if (e.chance(70))
+			g.comments.push_back(common_comments[e.next(5)]);
+		else
+			g.comments.push_back(random_str(e, symbol_chars, symbol_chars, 2));
+	}
+	n = e.next(8);
+	for (size_t i = 0; i < n; i++)
+		g.keywords.push_back(random_str(e, ident_begin_chars, ident_chars, 4));
+	n = e.next(12);
+	for (size_t i = 0; i < n; i++)
+		g.symbols.push_back(random_str(e, symbol_chars, symbol_chars, 3));
+	if (n && e.chance(10))
+		g.symbols.push_back(g.symbols[e.next(n)]);
+
+	/* rest of a broken symbol or comment is still lexable */
+	for (size_t i = 0; i < n; i++) {
+		std::string sym = g.symbols[i];
+		for (char c : sym)
+			add_symbol(g, std::string(1, c));
+	}
+	for (const std::string &comment : g.comments) {
+		for (char c : comment)
+			add_symbol(g, std::string(1, c));
+	}
+	if (g.comments.empty() && g.keywords.empty() && g.symbols.empty())
+		g.keywords.push_back("a");
+	g.enable_indent = e.chance(50);
+	return g;
+}
+
+static std::string random_input(entropy &e, const grammar &g)
+{
+	std::string src;
+	size_t lines = e.next(48);
+	for (size_t l = 0; l < lines; l++) {
+		size_t pieces = e.next(12);
+		if (g.enable_indent)
+			src.append(e.next(4), '\t');
+		for (size_t p = 0; p < pieces; p++) {
+			switch (e.next(7)) {
+			case 0:
+				src += random_str(e, ident_begin_chars, ident_chars, 6);
+				break;
+			case 1:
+				src += random_str(e, "0123456789", "0123456789", 20);
+				break;
+			case 2:
+				src += '"';
+				src += random_str(e, ident_chars, "ab 1+-;#/", 8);
+				src += '"';
+				break;
+			case 3:
+				if (!g.keywords.empty())
+					src += g.keywords[e.next(g.keywords.size())];
+				break;
+			default:
+				if (!g.symbols.empty())
+					src += g.symbols[e.next(g.symbols.size())];
+				break;
+			}
+			if (e.chance(50))
+				src += e.chance(90) ? ' ' : '\t';
+		}
+		if (e.chance(10))
+			src += "  ";
+		if (!g.comments.empty() && e.chance(20)) {
+			src += g.comments[e.next(g.comments.size())];
+			src += random_str(e, ident_chars, "ab 1", 10);
+			/* a comment at end of source without newline is unknown token */
+			src += '\n';
+		} else if (l + 1 < lines || e.chance(50)) {
+			src += '\n';
+		}
+	}
+	return src;
+}
+
+static void run_case(entropy &e)
+{
+	const spec_case *spec = nullptr;
+	grammar g;
+	if (e.chance(30)) {
+		spec = &spec_cases[e.next(std::size(spec_cases))];
+		g = spec->make();
+	} else {
+		g = random_grammar(e);
+	}
+	g.finish();
+	std::string src = random_input(e, g);
+
+	/* reference */
+	sclexer_config raw_cfg = g.config(0, true);
+	std::vector<norm_tok> raw = lex_stream(MODE_REFERENCE, &raw_cfg, nullptr,
+			src, nullptr);
+	std::vector<norm_tok> expected = filter(raw, 0, false);
+	sclexer_config cfg = g.config(0, false);
+
+	/* sclexer_get_tokens, and stats of it */
+	{
+		sclexer lexer{};
+		sclexer_tok *tokens = nullptr;
+		size_t count;
+		init_lexer(lexer, &cfg, nullptr, src);
+		timer t(MODE_GET_TOKENS);
+		count = sclexer_get_tokens(&lexer, &tokens);
+		t.stop(src.size(), count);
+		check(MODE_GET_TOKENS, "tokens", g, src, expected,
+				normalize_all(tokens, count, src.c_str()));
+		check_stats(MODE_GET_TOKENS, g, src, lexer.stats, expected);
+		std::free(tokens);
+	}
+
+	/* sclexer_reset after a half parsed source */
+	{
+		std::string prev = random_input(e, g);
+		std::vector<sclexer_tok> tokens;
+		sclexer lexer{};
+		sclexer_tok tok{};
+		lexer.cfg = &cfg;
+		lexer.src = prev.c_str();
+		lexer.src_siz = prev.size();
+		sclexer_init(&lexer, "prev");
+		for (size_t n = e.next(64); n && sclexer_get_tok(&lexer, &tok); n--)
+			;
+		tokens.reserve(src.size() / 2 + 4);
+
+		timer t(MODE_RESET);
+		sclexer_reset(&lexer, src.c_str(), src.size(), fpath);
+		while (sclexer_get_tok(&lexer, &tok))
+			tokens.push_back(tok);
+		t.stop(src.size(), tokens.size());
+		check(MODE_RESET, "tokens", g, src, expected,
+				normalize_all(tokens.data(), tokens.size(), src.c_str()));
+		check_stats(MODE_RESET, g, src, lexer.stats, expected);
+	}
+
+	/* skip_kinds and keep_dup_eol, of the config or of the lexer */
+	{
+		mask m{0, e.chance(30)};
+		const mask *lexer_mask = e.chance(50) ? &m : nullptr;
+		sclexer_stats stats;
+		for (int kind = SCLEXER_EOL; kind < SCLEXER_TOK_KIND_COUNT; kind++) {
+			if (e.chance(25))
+				m.skip_kinds |= SCLEXER_KIND_BIT(kind);
+		}
+		sclexer_config skip_cfg = lexer_mask
+			? g.config(0, false)
+			: g.config(m.skip_kinds, m.keep_dup_eol);
+		std::vector<norm_tok> want = filter(raw, m.skip_kinds, m.keep_dup_eol);
+		check(MODE_SKIP, "tokens", g, src, want,
+				lex_stream(MODE_SKIP, &skip_cfg, lexer_mask, src, &stats));
+		check_stats(MODE_SKIP, g, src, stats, want);
+		if (estimate_is_bound(g))
+			check_estimate(g, &skip_cfg, lexer_mask, src, stats);
+	}
+
+	/* scl::Lexer<> */
+	{
+		scl::Lexer<> lexer(g.options(0, false), src, fpath);
+		std::vector<sclexer_tok> tokens;
+		tokens.reserve(src.size() / 2 + 4);
+		timer t(MODE_CPP);
+		for (const sclexer_tok &tok : lexer)
+			tokens.push_back(tok);
+		t.stop(src.size(), tokens.size());
+		check(MODE_CPP, "tokens", g, src, expected,
+				normalize_all(tokens.data(), tokens.size(),
+					lexer.get()->src));
+		check_stats(MODE_CPP, g, src, lexer.stats(), expected);
+	}
+
+	/* scl::Lexer<>::reset after a half parsed source */
+	{
+		scl::Lexer<> lexer(g.options(0, false), random_input(e, g), "prev");
+		std::vector<sclexer_tok> tokens;
+		size_t n = e.next(64);
+		bool from_self = e.chance(20);
+		before_reset(lexer, n, from_self, src);
+		tokens.reserve(src.size() / 2 + 4);
+
+		timer t(MODE_CPP_RESET);
+		reset(lexer, from_self, src);
+		for (const sclexer_tok &tok : lexer)
+			tokens.push_back(tok);
+		t.stop(src.size(), tokens.size());
+		check(MODE_CPP_RESET, "tokens", g, src, expected,
+				normalize_all(tokens.data(), tokens.size(),
+					lexer.get()->src));
+		check_stats(MODE_CPP_RESET, g, src, lexer.stats(), expected);
+	}
+
+	/* scl::Lexer<Spec> */
+	if (spec) {
+		std::vector<norm_tok> want =
+			filter(raw, spec->skip_kinds, spec->keep_dup_eol);
+		std::string prev = random_input(e, g);
+		sclexer_stats stats;
+		check(MODE_SPEC, "tokens", g, src, want, spec->lex(src, &stats));
+		check_stats(MODE_SPEC, g, src, stats, want);
+		check(MODE_SPEC_RESET, "tokens", g, src, want,
+				spec->lex_reset(prev, e.next(64), e.chance(20),
+					src, &stats));
+		check_stats(MODE_SPEC_RESET, g, src, stats, want);
+	}
+}
+
+#ifdef SCLEXER_LIBFUZZER
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	entropy e(data, size);
+	run_case(e);
+	return 0;
+}
+#else
+int main(int argc, char *argv[])
+{
+	unsigned long long iterations = 2000, seed = 1;
+	if (argc > 1)
+		iterations = std::strtoull(argv[1], nullptr, 0);
+	if (argc > 2)
+		seed = std::strtoull(argv[2], nullptr, 0);
+
+	for (unsigned long long i = 0; i < iterations; i++) {
+		cur_seed = seed + i;
+		entropy e(cur_seed);
+		run_case(e);
+	}
+
+	std::printf("fuzz: %llu cases from seed %llu, all modes agree\n",
+			iterations, seed);
+	for (int i = 0; i < MODE_COUNT; i++) {
+		const throughput &m = modes[i];
+		std::printf("%-28s runs: %8zu, tokens: %10zu, %8.2f MiB/s\n",
+				mode_names[i], m.runs, m.tokens,
+				m.seconds > 0 ? m.bytes / m.seconds / (1 << 20) : 0.0);
+	}
+	return 0;
+}
+#endif
@@ -49,24 +49,28 @@ int main(int argc, char *argv[])
 {
 	char *src;
 	const char *fpath;
+	struct sclexer_config cfg = {0};
 	struct sclexer lexer = {0};
 	if (argc < 2)
 		return 1;
 	fpath = argv[1];
 
-	lexer.enable_indent = true;
+	cfg.enable_indent = true;
 
-	lexer.src_siz = sclexer_read_file(&src, fpath);
-	lexer.src = src;
+	cfg.comments = comments;
+	cfg.comments_count = COMMENTS_COUNT;
 
-	lexer.comments = comments;
-	lexer.comments_count = COMMENTS_COUNT;
+	cfg.keywords = keywords;
+	cfg.keywords_count = KEYWORDS_COUNT;
 
-	lexer.keywords = keywords;
-	lexer.keywords_count = KEYWORDS_COUNT;
+	cfg.symbols = symbols;
+	cfg.symbols_count = SYMBOLS_COUNT;
 
-	lexer.symbols = symbols;
-	lexer.symbols_count = SYMBOLS_COUNT;
+	sclexer_config_init(&cfg);
+
+	lexer.cfg = &cfg;
+	lexer.src_siz = sclexer_read_file(&src, fpath);
+	lexer.src = src;
 
 	sclexer_init(&lexer, fpath);
 
@@ -76,10 +80,18 @@ int main(int argc, char *argv[])
 		print_tok(&tok);
 	*/
 
+	struct sclexer_stats estimated;
+	sclexer_estimate_tokens(&lexer, &estimated);
+
 	struct sclexer_tok *tokens = NULL;
 	size_t tokens_count = sclexer_get_tokens(&lexer, &tokens);
 	for (size_t i = 0; i < tokens_count; i++)
 		sclexer_print_tok(&lexer, &tokens[i]);
 
+	printf("estimated:\n");
+	sclexer_print_stats(&estimated);
+	printf("actual:\n");
+	sclexer_print_stats(&lexer.stats);
+
 	return 0;
 }
@@ -1,13 +1,25 @@
 /* Simple lexer in C
  *
  * Usage:
- *     * Setup a 'struct sclexer' and pass it to 'sclexer_init',
- *       and the 'fpath' argument of 'sclexer_init' can be NULL.
- *     * Give a file content to 'src' and 'src_siz' of 'struct sclexer',
+ *     * Setup a 'struct sclexer_config' and pass it to 'sclexer_config_init',
+ *       it is read only after that and can be shared by many lexers.
+ *     * Setup 'cfg', 'src' and 'src_siz' of a 'struct sclexer'
+ *       and pass it to 'sclexer_init'.
  *       If you want to read a file and get the content of it,
  *       use 'sclexer_read_file'.
  *     * Parse the 'src' by 'sclexer_get_tok' or just use 'sclexer_get_tokens'
  *       to parse all content of 'src'.
+ *     * Parse another source with same config by 'sclexer_reset',
+ *       the config won't be checked and built again.
+ *     * 'sclexer_estimate_tokens' guesses count of tokens before parsing,
+ *       and 'stats' of 'struct sclexer' counts the returned tokens.
+ *     * Tokens you don't care can be dropped by 'skip_kinds' before
+ *       they are returned, both of the functions give the same tokens.
+ *       It's set for each lexer, the one of 'cfg' is just the default.
+ *
+ * C++:
+ *     Include 'sclexer.hpp' instead, but the implementation must still be
+ *     compiled by a C compiler, in a C file with 'SCLEXER_IMPL'.
  *
  * Options:
  *     SCLEXER_DISABLE_MSG_COLOR:    disable message color.
@@ -36,10 +48,38 @@
  * SOFTWARE. */
 #ifndef SCLEXER_H
 #define SCLEXER_H
+#include <limits.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdint.h>
 
+/* Message formats, also used by 'sclexer.hpp' */
+#define _SCLEXER_ERR_FMT "libsclexer: %s:%s:%d: "
+#define _SCLEXER_ERR_FMT_ARG __FILE__, __func__, __LINE__
+
+#ifndef SCLEXER_DISABLE_MSG_COLOR
+#define _SCLEXER_MSG_COLOR(MSG, COLOR) COLOR MSG _SCLEXER_MSG_COLOR_RESET
+#define _SCLEXER_MSG_COLOR_LOC(MSG) _SCLEXER_MSG_COLOR(MSG, "\x1b[31m")
+#define _SCLEXER_MSG_COLOR_RESET "\x1b[0m"
+#else
+#define _SCLEXER_MSG_COLOR(MSG, ...) MSG
+#define _SCLEXER_MSG_COLOR_LOC(MSG) MSG
+#define _SCLEXER_MSG_COLOR_RESET
+#endif // SCLEXER_DISABLE_MSG_COLOR
+
+#ifndef SCLEXER_DISABLE_MORE_LOC_MSG
+#define _SCLEXER_TOK_LOC_FMT _SCLEXER_MSG_COLOR_LOC("f:%s,l:%lu,c:%lu")
+#define _SCLEXER_TOK_LOC_UNWRAP(TOK) \
+	(TOK)->loc.fpath, (TOK)->loc.line, (TOK)->loc.column
+#else
+#define _SCLEXER_TOK_LOC_FMT _SCLEXER_MSG_COLOR_LOC("l:%lu,c:%lu")
+#define _SCLEXER_TOK_LOC_UNWRAP(TOK) (TOK)->loc.line, (TOK)->loc.column
+#endif // SCLEXER_DISABLE_MORE_LOC_MSG
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 enum SCLEXER_TOK_KIND {
 	SCLEXER_UNKNOWN_TOK,
 	SCLEXER_EOF,
@@ -58,6 +98,8 @@ enum SCLEXER_TOK_KIND {
 	SCLEXER_TOK_KIND_COUNT
 };
 
+#define SCLEXER_KIND_BIT(KIND) ((uint32_t)1 << (KIND))
+
 struct sclexer_str_slice {
 	const char *begin;
 	size_t len;
@@ -88,42 +130,103 @@ struct sclexer_tok {
 	struct sclexer_loc loc;
 };
 
-struct sclexer {
+struct sclexer_stats {
+	size_t kinds[SCLEXER_TOK_KIND_COUNT];
+	/* sum of 'kinds' */
+	size_t tokens;
+	/* bytes of source to the end of the last token */
+	size_t bytes;
+};
+
+struct sclexer_config {
 	bool enable_indent;
 	bool (*is_ident)(char c, bool begin);
 
 	/* Single line comments, such as ";" and "//",
 	 * so I think you will know what means of it.
-	 * (It won't be setup by 'sclexer_init')
+	 * (It won't be setup by 'sclexer_config_init')
 	 */
 	const char **comments;
 	size_t comments_count;
 
 	/* Like "~!@#$%^&*()-_+=" or setup else by yourself?
-	 * (It won't be setup by 'sclexer_init')
+	 * (It won't be setup by 'sclexer_config_init')
 	 */
 	const char **symbols;
 	size_t symbols_count;
 
 	/* Like "enum", "struct", "define",
 	 * or just call it "special ientifier"
-	 * (It won't be setup by 'sclexer_init')
+	 * (It won't be setup by 'sclexer_config_init')
 	 */
 	const char **keywords;
 	size_t keywords_count;
 
+	/* Defaults of 'skip_kinds' and 'keep_dup_eol' of 'struct sclexer',
+	 * copied by 'sclexer_init'.
+	 */
+	uint32_t skip_kinds;
+	bool keep_dup_eol;
+
+	/* Setup by 'sclexer_config_init' */
+	bool _ready;
+	/* '_SCLEXER_FIRST_xxx' flags of the first char of comments and symbols */
+	unsigned char _first[UCHAR_MAX + 1];
+	/* Bit 'n' is set when there is a keyword of 'n' chars (63 for longer) */
+	uint64_t _keywords_len;
+};
+
+struct sclexer {
+	/* Initialized by 'sclexer_config_init' */
+	const struct sclexer_config *cfg;
+
 	/* Preparing for parsing string */
 	const char *src;
 	size_t src_siz;
 
+	/* Kinds of token which won't be returned, build it by 'SCLEXER_KIND_BIT',
+	 * like 'SCLEXER_KIND_BIT(SCLEXER_EOL)'.
+	 * ('SCLEXER_EOF' is never returned, so skip it is meaningless)
+	 * Set by 'sclexer_init' from 'cfg' and kept by 'sclexer_reset',
+	 * change it after 'sclexer_init' for this lexer only.
+	 */
+	uint32_t skip_kinds;
+	/* Repeated EOL are coalesced into one by default,
+	 * set it if you want all of them. Same as 'skip_kinds'.
+	 */
+	bool keep_dup_eol;
+
+	/* Tokens returned since 'sclexer_reset', read only */
+	struct sclexer_stats stats;
+
 	bool _after_endl;
 	const char *_cur;
 	size_t _last_indent;
 	struct sclexer_loc _loc;
+	enum SCLEXER_TOK_KIND _prev_kind;
 };
 
+/**
+ * Check the options and build the tables of 'self',
+ * don't modify it after that.
+ */
+void sclexer_config_init(struct sclexer_config *self);
+
 bool sclexer_default_is_ident(char c, bool begin);
 
+/**
+ * Guess tokens of the rest of source by counting newlines, runs of digits
+ * and identifiers, and chars may begin a symbol, without parsing.
+ * Symbols longer than one char and repeated EOL are over counted,
+ * so it's an upper bound, unless a symbol begins with an identifier char
+ * or a comment may begin inside a symbol.
+ *
+ * @param result: NULL | estimated count of each kind.
+ * @return: estimated count of tokens.
+ */
+size_t sclexer_estimate_tokens(const struct sclexer *self,
+		struct sclexer_stats *result);
+
 /**
  * Just copy the content of 'dst' to 'src' without any memory allocate.
  * So, 'src' and 'dst' must be a correct memory.
@@ -137,7 +240,7 @@ bool sclexer_get_tok(struct sclexer *self,
 		struct sclexer_tok *tok);
 
 /**
- * Before calling this function, setup all options without '_xxx' in 'lexer'.
+ * Before calling this function, setup 'cfg', 'src' and 'src_siz' in 'lexer'.
  * If you need read a file, use 'sclexer_read_file'
  * and pass the result to this function.
  *
@@ -146,10 +249,30 @@ bool sclexer_get_tok(struct sclexer *self,
  */
 void sclexer_init(struct sclexer *self, const char *fpath);
 
+/**
+ * Start to parse 'src' with the same 'cfg', the state of previous source
+ * is dropped. It is cheap, so call it for each source instead of
+ * setting up a new lexer.
+ */
+void sclexer_reset(struct sclexer *self,
+		const char *src,
+		size_t len,
+		const char *fpath);
+
 const char *sclexer_kind_names(enum SCLEXER_TOK_KIND kind);
 
 size_t sclexer_get_tokens(struct sclexer *self, struct sclexer_tok **result);
 
+/**
+ * Cheap guess of tokens of the rest of source for a buffer of them,
+ * 'sclexer_estimate_tokens' on a few windows across source, scaled by
+ * 'src_siz'. It falls back to the head of source when 'src_siz'
+ * is unset or behind the cursor.
+ */
+size_t sclexer_guess_tokens(const struct sclexer *self);
+
+void sclexer_print_stats(const struct sclexer_stats *stats);
+
 void sclexer_print_tok(struct sclexer *self, struct sclexer_tok *tok);
 
 /**
@@ -160,6 +283,10 @@ void sclexer_print_tok(struct sclexer *self, struct sclexer_tok *tok);
  */
 size_t sclexer_read_file(char **result, const char *fpath);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
 
 #ifdef SCLEXER_IMPL
@@ -171,27 +298,15 @@ size_t sclexer_read_file(char **result, const char *fpath);
 #include <string.h>
 
 #define _SCLEXER_DEFAULT_TOKENS_CAPACITY 64
-#define _SCLEXER_ERR_FMT "libsclexer: %s:%s:%d: "
-#define _SCLEXER_ERR_FMT_ARG __FILE__, __func__, __LINE__
-
-#ifndef SCLEXER_DISABLE_MSG_COLOR
-#define _SCLEXER_MSG_COLOR(MSG, COLOR) COLOR MSG _SCLEXER_MSG_COLOR_RESET
-#define _SCLEXER_MSG_COLOR_LOC(MSG) _SCLEXER_MSG_COLOR(MSG, "\x1b[31m")
-#define _SCLEXER_MSG_COLOR_RESET "\x1b[0m"
-#else
-#define _SCLEXER_MSG_COLOR(MSG, ...) MSG
-#define _SCLEXER_MSG_COLOR_LOC(MSG) MSG
-#define _SCLEXER_MSG_COLOR_RESET
-#endif // SCLEXER_DISABLE_MSG_COLOR
-
-#ifndef SCLEXER_DISABLE_MORE_LOC_MSG
-#define _SCLEXER_TOK_LOC_FMT _SCLEXER_MSG_COLOR_LOC("f:%s,l:%lu,c:%lu")
-#define _SCLEXER_TOK_LOC_UNWRAP(TOK) \
-	(TOK)->loc.fpath, (TOK)->loc.line, (TOK)->loc.column
-#else
-#define _SCLEXER_TOK_LOC_FMT _SCLEXER_MSG_COLOR_LOC("l:%lu,c:%lu")
-#define _SCLEXER_TOK_LOC_UNWRAP(TOK) (TOK)->loc.line, (TOK)->loc.column
-#endif // SCLEXER_DISABLE_MORE_LOC_MSG
+/* 'sclexer_guess_tokens' estimates a window of these bytes
+ * for each 'SPREAD' bytes of source, 'WINDOWS' at most.
+ */
+#define _SCLEXER_ESTIMATE_SAMPLE 256
+#define _SCLEXER_ESTIMATE_SPREAD 4096
+#define _SCLEXER_ESTIMATE_WINDOWS 8
+#define _SCLEXER_FIRST_COMMENT 0x1
+#define _SCLEXER_FIRST_SYMBOL  0x2
+#define _SCLEXER_KEYWORD_LEN_BIT(LEN) ((uint64_t)1 << ((LEN) < 63 ? (LEN) : 63))
 
 #define _SCLEXER_TOK_KIND_FMT _SCLEXER_MSG_COLOR("%s", "\x1b[32m")
 #define _SCLEXER_TOK_KIND_FMT_ARG(TOK) kind_names[(TOK)->kind]
@@ -242,10 +357,36 @@ static bool _sclexer_do_eof(struct sclexer *self, struct sclexer_tok *tok);
 static size_t _sclexer_do_ident(struct sclexer *self, struct sclexer_tok *tok);
 static void _sclexer_drop_space(struct sclexer *self);
 static size_t _sclexer_drop_until_endl(struct sclexer *self);
-static bool _sclexer_is_prev_eol(struct sclexer_tok *tokens,
-		struct sclexer_tok *cur_tok,
-		size_t count);
+/**
+ * 'sclexer_estimate_tokens' on about 'limit' bytes from 'begin',
+ * 'indent' and 'line_begin' are the state of lexer there.
+ */
+static size_t _sclexer_estimate(const struct sclexer *self,
+		const char *begin,
+		size_t indent,
+		bool line_begin,
+		size_t limit,
+		struct sclexer_stats *result);
+/**
+ * Same as parsing digit, string, symbol and ident, but only count them.
+ * @return: bytes of the token.
+ */
+static size_t _sclexer_estimate_tok(const struct sclexer_config *cfg,
+		const char *cur,
+		struct sclexer_stats *stats);
+/**
+ * @param keyword: index of the keyword when found.
+ */
+static bool _sclexer_find_keyword(const struct sclexer_config *cfg,
+		const char *begin,
+		size_t len,
+		size_t *keyword);
+static bool _sclexer_is_comment(const struct sclexer_config *cfg,
+		const char *cur);
+static bool _sclexer_is_skipped(struct sclexer *self,
+		enum SCLEXER_TOK_KIND kind);
 static void _sclexer_next_line(struct sclexer *self);
+static bool _sclexer_scan_tok(struct sclexer *self, struct sclexer_tok *tok);
 static size_t _sclexer_try_comment(struct sclexer *self);
 static size_t _sclexer_try_digit(struct sclexer *self, struct sclexer_tok *tok);
 static bool _sclexer_try_endl(struct sclexer *self, struct sclexer_tok *tok);
@@ -282,6 +423,9 @@ size_t _sclexer_cmp_src_with_cstr(const char *cur, const char *cstr)
 		if (cur[i] != cstr[i])
 			return 0;
 	}
+	/* 'cur' ended before 'cstr' */
+	if (cstr[i] != '\0')
+		return 0;
 	return i;
 }
 
@@ -299,11 +443,11 @@ bool _sclexer_do_eof(struct sclexer *self, struct sclexer_tok *tok)
 size_t _sclexer_do_ident(struct sclexer *self, struct sclexer_tok *tok)
 {
 	size_t readed = 0;
-	if (!self->is_ident(self->_cur[0], true))
+	if (!self->cfg->is_ident(self->_cur[0], true))
 		return 0;
 	readed = 1;
 	for (; self->_cur[readed] != '\0'; readed++) {
-		if (!self->is_ident(self->_cur[readed], false))
+		if (!self->cfg->is_ident(self->_cur[readed], false))
 			goto end;
 	}
 end:
@@ -334,17 +478,138 @@ size_t _sclexer_drop_until_endl(struct sclexer *self)
 	return 0;
 }
 
-bool _sclexer_is_prev_eol(struct sclexer_tok *tokens,
-		struct sclexer_tok *cur_tok,
-		size_t count)
+size_t _sclexer_estimate(const struct sclexer *self,
+		const char *begin,
+		size_t indent,
+		bool line_begin,
+		size_t limit,
+		struct sclexer_stats *result)
 {
-	if (count == 0)
-		return false;
-	if (cur_tok->kind != SCLEXER_EOL)
+	const struct sclexer_config *cfg = self->cfg;
+	struct sclexer_stats stats = {0};
+	const char *cur = begin, *endl;
+	size_t readed;
+	bool has_endl = true;
+	while (cur[0] != '\0' && (size_t)(cur - begin) < limit) {
+		/* like '_sclexer_try_indent', one block at most for each line */
+		if (line_begin && cfg->enable_indent) {
+			for (readed = 0; cur[readed] == '\t'; readed++)
+				;
+			if (readed > indent) {
+				stats.kinds[SCLEXER_INDENT_BLOCK_BEGIN]++;
+				indent++;
+			} else if (readed < indent) {
+				stats.kinds[SCLEXER_INDENT_BLOCK_END]++;
+				indent--;
+			}
+		}
+		line_begin = false;
+		if (cur[0] == '\n') {
+			stats.kinds[SCLEXER_EOL]++;
+			line_begin = true;
+			cur++;
+		} else if (isspace(cur[0])) {
+			cur++;
+		} else if (has_endl && _sclexer_is_comment(cfg, cur)) {
+			/* like '_sclexer_try_endl', no EOL after, no comment */
+			if ((endl = strchr(cur, '\n')))
+				cur = endl;
+			else
+				has_endl = false;
+		} else {
+			cur += _sclexer_estimate_tok(cfg, cur, &stats);
+		}
+	}
+	/* the last EOL, and a pair of EOL and block end for each opened block */
+	stats.kinds[SCLEXER_EOL] += indent + 1;
+	stats.kinds[SCLEXER_INDENT_BLOCK_END] += indent;
+	stats.bytes = cur - begin;
+	for (int i = 0; i < SCLEXER_TOK_KIND_COUNT; i++) {
+		if (self->skip_kinds & SCLEXER_KIND_BIT(i))
+			stats.kinds[i] = 0;
+		stats.tokens += stats.kinds[i];
+	}
+	if (result)
+		*result = stats;
+	return stats.tokens;
+}
+
+size_t _sclexer_estimate_tok(const struct sclexer_config *cfg,
+		const char *cur,
+		struct sclexer_stats *stats)
+{
+	size_t keyword, readed = 0;
+	if (isdigit(cur[0])) {
+		while (isdigit(cur[readed]))
+			readed++;
+		stats->kinds[SCLEXER_INT]++;
+		return readed;
+	}
+	if (cur[0] == '"') {
+		readed = 1;
+		while (cur[readed] != '"' && cur[readed] != '\n' && cur[readed] != '\0')
+			readed++;
+		if (cur[readed] == '"') {
+			stats->kinds[SCLEXER_STRING]++;
+			return readed + 1;
+		}
+	}
+	if (cfg->_first[(unsigned char)cur[0]] & _SCLEXER_FIRST_SYMBOL) {
+		stats->kinds[SCLEXER_SYMBOL]++;
+		return 1;
+	}
+	if (cfg->is_ident(cur[0], true)) {
+		readed = 1;
+		while (cur[readed] != '\0' && cfg->is_ident(cur[readed], false))
+			readed++;
+		if (_sclexer_find_keyword(cfg, cur, readed, &keyword))
+			stats->kinds[SCLEXER_KEYWORD]++;
+		else
+			stats->kinds[SCLEXER_IDENT]++;
+		return readed;
+	}
+	/* unknown token */
+	return 1;
+}
+
+bool _sclexer_find_keyword(const struct sclexer_config *cfg,
+		const char *begin,
+		size_t len,
+		size_t *keyword)
+{
+	if (!(cfg->_keywords_len & _SCLEXER_KEYWORD_LEN_BIT(len)))
 		return false;
-	if (tokens[count - 1].kind != SCLEXER_EOL)
+	for (size_t i = 0; i < cfg->keywords_count; i++) {
+		if (strlen(cfg->keywords[i]) != len)
+			continue;
+		if (strncmp(cfg->keywords[i], begin, len) == 0) {
+			*keyword = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool _sclexer_is_comment(const struct sclexer_config *cfg,
+		const char *cur)
+{
+	if (!(cfg->_first[(unsigned char)cur[0]] & _SCLEXER_FIRST_COMMENT))
 		return false;
-	return true;
+	for (size_t i = 0; i < cfg->comments_count; i++) {
+		if (_sclexer_cmp_src_with_cstr(cur, cfg->comments[i]))
+			return true;
+	}
+	return false;
+}
+
+bool _sclexer_is_skipped(struct sclexer *self,
+		enum SCLEXER_TOK_KIND kind)
+{
+	if (self->skip_kinds & SCLEXER_KIND_BIT(kind))
+		return true;
+	if (kind == SCLEXER_EOL && !self->keep_dup_eol)
+		return self->_prev_kind == SCLEXER_EOL;
+	return false;
 }
 
 void _sclexer_next_line(struct sclexer *self)
@@ -354,12 +619,67 @@ void _sclexer_next_line(struct sclexer *self)
 	self->_loc.column = 1;
 }
 
-size_t _sclexer_try_comment(struct sclexer *self)
+bool _sclexer_scan_tok(struct sclexer *self, struct sclexer_tok *tok)
 {
-	for (size_t i = 0; i < self->comments_count; i++) {
-		if (_sclexer_cmp_src_with_cstr(self->_cur, self->comments[i]))
-			return _sclexer_drop_until_endl(self);
+	size_t readed = 0;
+	tok->src.begin = self->_cur;
+	tok->src.len = 0;
+	tok->loc = self->_loc;
+	tok->kind = SCLEXER_UNKNOWN_TOK;
+
+	if (_sclexer_try_indent(self, tok)) {
+		self->_after_endl = false;
+		return true;
+	}
+
+	if (self->_cur[0] == '\0') {
+		if (!self->_after_endl) {
+			tok->kind = SCLEXER_EOL;
+			self->_after_endl = true;
+			return true;
+		}
+		return false;
 	}
+	if (self->_after_endl)
+		self->_after_endl = false;
+
+	_sclexer_drop_space(self);
+	if (self->_cur[0] == '\0')
+		return _sclexer_do_eof(self, tok);
+
+	tok->src.begin = self->_cur;
+	tok->loc = self->_loc;
+
+	if (_sclexer_try_endl(self, tok))
+		return true;
+	if ((readed = _sclexer_try_digit(self, tok)))
+		goto end;
+	if ((readed = _sclexer_try_string(self, tok)))
+		goto end;
+	if ((readed = _sclexer_try_symbol(self, tok)))
+		goto end;
+	if ((readed = _sclexer_do_ident(self, tok))) {
+		/* nobody wants to know it is a keyword or not */
+		if (!_sclexer_is_skipped(self, SCLEXER_IDENT)
+				|| !_sclexer_is_skipped(self, SCLEXER_KEYWORD))
+			_sclexer_try_keyword(self, tok);
+		goto end;
+	}
+	_sclexer_eprintf(_SCLEXER_ERR_FMT"unknown token '%c' "_SCLEXER_TOK_LOC_FMT"\n",
+			_SCLEXER_ERR_FMT_ARG,
+			self->_cur[0],
+			_SCLEXER_TOK_LOC_UNWRAP(tok));
+	return false;
+end:
+	_sclexer_advance(self, readed);
+	tok->src.len = readed;
+	return true;
+}
+
+size_t _sclexer_try_comment(struct sclexer *self)
+{
+	if (_sclexer_is_comment(self->cfg, self->_cur))
+		return _sclexer_drop_until_endl(self);
 	return 0;
 }
 
@@ -402,7 +722,7 @@ bool _sclexer_try_endl(struct sclexer *self, struct sclexer_tok *tok)
 bool _sclexer_try_indent(struct sclexer *self, struct sclexer_tok *tok)
 {
 	size_t readed = 0;
-	if (!self->enable_indent)
+	if (!self->cfg->enable_indent)
 		return false;
 	if (!self->_after_endl)
 		return false;
@@ -422,16 +742,10 @@ bool _sclexer_try_indent(struct sclexer *self, struct sclexer_tok *tok)
 
 void _sclexer_try_keyword(struct sclexer *self, struct sclexer_tok *tok)
 {
-	for (size_t i = 0; i < self->keywords_count; i++) {
-		if (strlen(self->keywords[i]) != tok->src.len)
-			continue;
-		if (strncmp(self->keywords[i],
-					tok->src.begin,
-					tok->src.len) == 0) {
-			tok->data.keyword = i;
-			tok->kind = SCLEXER_KEYWORD;
-			return;
-		}
+	size_t keyword;
+	if (_sclexer_find_keyword(self->cfg, tok->src.begin, tok->src.len, &keyword)) {
+		tok->data.keyword = keyword;
+		tok->kind = SCLEXER_KEYWORD;
 	}
 }
 
@@ -457,9 +771,12 @@ size_t _sclexer_try_string(struct sclexer *self, struct sclexer_tok *tok)
 
 size_t _sclexer_try_symbol(struct sclexer *self, struct sclexer_tok *tok)
 {
+	const struct sclexer_config *cfg = self->cfg;
 	size_t prev = 0, readed = 0;
-	for (size_t i = 0; i < self->symbols_count; i++) {
-		readed = _sclexer_cmp_src_with_cstr(self->_cur, self->symbols[i]);
+	if (!(cfg->_first[(unsigned char)self->_cur[0]] & _SCLEXER_FIRST_SYMBOL))
+		return 0;
+	for (size_t i = 0; i < cfg->symbols_count; i++) {
+		readed = _sclexer_cmp_src_with_cstr(self->_cur, cfg->symbols[i]);
 		if (readed == 0)
 			continue;
 		if (readed < prev)
@@ -471,6 +788,30 @@ size_t _sclexer_try_symbol(struct sclexer *self, struct sclexer_tok *tok)
 	return prev;
 }
 
+void sclexer_config_init(struct sclexer_config *self)
+{
+	_sclexer_check(self)
+	if (!self->comments
+			&& !self->symbols
+			&& !self->keywords) {
+		_sclexer_eprintf(_SCLEXER_ERR_FMT"need more parameters\n",
+				_SCLEXER_ERR_FMT_ARG);
+	}
+	if (!self->is_ident)
+		self->is_ident = sclexer_default_is_ident;
+	memset(self->_first, 0, sizeof(self->_first));
+	for (size_t i = 0; i < self->comments_count; i++)
+		self->_first[(unsigned char)self->comments[i][0]] |= _SCLEXER_FIRST_COMMENT;
+	for (size_t i = 0; i < self->symbols_count; i++)
+		self->_first[(unsigned char)self->symbols[i][0]] |= _SCLEXER_FIRST_SYMBOL;
+	/* empty comments and symbols never match */
+	self->_first[0] = 0;
+	self->_keywords_len = 0;
+	for (size_t i = 0; i < self->keywords_count; i++)
+		self->_keywords_len |= _SCLEXER_KEYWORD_LEN_BIT(strlen(self->keywords[i]));
+	self->_ready = true;
+}
+
 bool sclexer_default_is_ident(char c, bool begin)
 {
 	if (begin && isdigit(c))
@@ -482,6 +823,17 @@ bool sclexer_default_is_ident(char c, bool begin)
 	return false;
 }
 
+size_t sclexer_estimate_tokens(const struct sclexer *self,
+		struct sclexer_stats *result)
+{
+	_sclexer_check(self && self->cfg && self->_cur)
+	return _sclexer_estimate(self, self->_cur,
+			self->_last_indent,
+			self->_after_endl,
+			SIZE_MAX,
+			result);
+}
+
 void sclexer_dup_tok(struct sclexer_tok *dst, struct sclexer_tok *src)
 {
 	_sclexer_check(dst && src);
@@ -491,75 +843,45 @@ void sclexer_dup_tok(struct sclexer_tok *dst, struct sclexer_tok *src)
 bool sclexer_get_tok(struct sclexer *self,
 		struct sclexer_tok *tok)
 {
-	size_t readed = 0;
 	_sclexer_check(self && tok);
 	_sclexer_check(self->src && self->_cur);
-
-	tok->src.begin = self->_cur;
-	tok->loc = self->_loc;
-	tok->kind = SCLEXER_UNKNOWN_TOK;
-
-	if (_sclexer_try_indent(self, tok)) {
-		self->_after_endl = false;
-		return true;
-	}
-
-	if (self->_cur[0] == '\0') {
-		if (!self->_after_endl) {
-			tok->kind = SCLEXER_EOL;
-			self->_after_endl = true;
-			return true;
-		}
-		return false;
-	}
-	if (self->_after_endl)
-		self->_after_endl = false;
-
-	_sclexer_drop_space(self);
-	if (self->_cur[0] == '\0')
-		return _sclexer_do_eof(self, tok);
-
-	tok->src.begin = self->_cur;
-	tok->loc = self->_loc;
-
-	if (_sclexer_try_endl(self, tok))
+	while (_sclexer_scan_tok(self, tok)) {
+		if (_sclexer_is_skipped(self, tok->kind))
+			continue;
+		self->_prev_kind = tok->kind;
+		self->stats.kinds[tok->kind]++;
+		self->stats.tokens++;
+		self->stats.bytes = tok->src.begin + tok->src.len - self->src;
 		return true;
-	if ((readed = _sclexer_try_digit(self, tok)))
-		goto end;
-	if ((readed = _sclexer_try_string(self, tok)))
-		goto end;
-	if ((readed = _sclexer_try_symbol(self, tok)))
-		goto end;
-	if ((readed = _sclexer_do_ident(self, tok))) {
-		_sclexer_try_keyword(self, tok);
-		goto end;
 	}
-	_sclexer_eprintf(_SCLEXER_ERR_FMT"unknown token '%c' "_SCLEXER_TOK_LOC_FMT"\n",
-			_SCLEXER_ERR_FMT_ARG,
-			self->_cur[0],
-			_SCLEXER_TOK_LOC_UNWRAP(tok));
 	return false;
-end:
-	_sclexer_advance(self, readed);
-	tok->src.len = readed;
-	return true;
 }
 
 void sclexer_init(struct sclexer *self, const char *fpath)
 {
 	_sclexer_check(self)
-	_sclexer_check(self->src)
+	_sclexer_check(self->cfg)
+	self->skip_kinds = self->cfg->skip_kinds;
+	self->keep_dup_eol = self->cfg->keep_dup_eol;
+	sclexer_reset(self, self->src, self->src_siz, fpath);
+}
+
+void sclexer_reset(struct sclexer *self,
+		const char *src,
+		size_t len,
+		const char *fpath)
+{
+	_sclexer_check(self)
+	_sclexer_check(self->cfg && self->cfg->_ready)
+	_sclexer_check(src)
 	_sclexer_check(fpath)
-	if (!self->comments
-			&& !self->symbols
-			&& !self->keywords) {
-		_sclexer_eprintf(_SCLEXER_ERR_FMT"need more parameters\n",
-				_SCLEXER_ERR_FMT_ARG);
-	}
-	if (!self->is_ident)
-		self->is_ident = sclexer_default_is_ident;
+	self->src = src;
+	self->src_siz = len;
+	memset(&self->stats, 0, sizeof(self->stats));
+	self->_after_endl = false;
 	self->_cur = self->src;
 	self->_last_indent = 0;
+	self->_prev_kind = SCLEXER_UNKNOWN_TOK;
 	self->_loc.fpath  = fpath;
 	self->_loc.line   = 1;
 	self->_loc.column = 1;
@@ -574,25 +896,89 @@ const char *sclexer_kind_names(enum SCLEXER_TOK_KIND kind)
 
 size_t sclexer_get_tokens(struct sclexer *self, struct sclexer_tok **result)
 {
-	size_t count = 0, capacity = _SCLEXER_DEFAULT_TOKENS_CAPACITY;
-	struct sclexer_tok cur_tok = {0};
+	/* and a free slot */
+	size_t count = 0, capacity = sclexer_guess_tokens(self) + 1;
 	struct sclexer_tok *tokens = NULL;
 	tokens = _sclexer_ereallocz(tokens, sizeof(*tokens) * capacity);
-	for (; sclexer_get_tok(self, &cur_tok); count++) {
-		if (_sclexer_is_prev_eol(tokens, &cur_tok, count)) {
-			count--;
+	/* lex into the buffer directly, always keep a free slot for it */
+	while (sclexer_get_tok(self, &tokens[count])) {
+		if (++count < capacity)
 			continue;
-		}
-		if (count == capacity) {
-			capacity += _SCLEXER_DEFAULT_TOKENS_CAPACITY;
-			tokens = _sclexer_ereallocz(tokens, sizeof(*tokens) * capacity);
-		}
-		sclexer_dup_tok(&tokens[count], &cur_tok);
+		capacity *= 2;
+		tokens = _sclexer_ereallocz(tokens, sizeof(*tokens) * capacity);
 	}
 	*result = tokens;
 	return count;
 }
 
+size_t sclexer_guess_tokens(const struct sclexer *self)
+{
+	struct sclexer_stats sample;
+	const char *win, *endl;
+	size_t done, indent, rest, windows, tokens = 0, bytes = 0;
+	bool line_begin;
+	_sclexer_check(self && self->cfg && self->src && self->_cur)
+	done = self->_cur - self->src;
+	if (done >= self->src_siz) {
+		tokens = _sclexer_estimate(self, self->_cur,
+				self->_last_indent,
+				self->_after_endl,
+				_SCLEXER_ESTIMATE_SAMPLE,
+				NULL);
+		return tokens > _SCLEXER_DEFAULT_TOKENS_CAPACITY
+			? tokens : _SCLEXER_DEFAULT_TOKENS_CAPACITY;
+	}
+	rest = self->src_siz - done;
+	if (rest <= _SCLEXER_ESTIMATE_SAMPLE) {
+		return _sclexer_estimate(self, self->_cur,
+				self->_last_indent,
+				self->_after_endl,
+				SIZE_MAX,
+				NULL);
+	}
+	/* so a license header won't be the whole sample */
+	windows = rest / _SCLEXER_ESTIMATE_SPREAD;
+	if (windows == 0)
+		windows = 1;
+	else if (windows > _SCLEXER_ESTIMATE_WINDOWS)
+		windows = _SCLEXER_ESTIMATE_WINDOWS;
+	for (size_t i = 0; i < windows; i++) {
+		win = self->_cur + rest / windows * i;
+		indent = self->_last_indent;
+		line_begin = self->_after_endl;
+		/* begin at a line, indent there is unknown */
+		if (i && (endl = memchr(win, '\n', _SCLEXER_ESTIMATE_SAMPLE))) {
+			win = endl + 1;
+			indent = 0;
+			line_begin = true;
+		}
+		tokens += _sclexer_estimate(self, win, indent, line_begin,
+				_SCLEXER_ESTIMATE_SAMPLE,
+				&sample);
+		bytes += sample.bytes;
+	}
+	if (bytes == 0)
+		return _SCLEXER_DEFAULT_TOKENS_CAPACITY;
+	/* 1/4 more for the samples being lucky */
+	tokens = (double)tokens / bytes * rest;
+	tokens += tokens / 4;
+	/* one EOL and one indent block token per byte at most */
+	return tokens < rest * 2 ? tokens : rest * 2;
+}
+
+void sclexer_print_stats(const struct sclexer_stats *stats)
+{
+	for (int i = 0; i < SCLEXER_TOK_KIND_COUNT; i++) {
+		if (stats->kinds[i] == 0)
+			continue;
+		printf(_SCLEXER_TOK_KIND_FMT": %lu\n", kind_names[i], stats->kinds[i]);
+	}
+	printf("tokens: %lu, bytes: %lu, bytes per token: %.2f\n",
+			stats->tokens,
+			stats->bytes,
+			stats->tokens ? (double)stats->bytes / stats->tokens : 0.0);
+}
+
 /* shits, is's cannot be readed. */
 void sclexer_print_tok(struct sclexer *self, struct sclexer_tok *tok)
 {
@@ -621,13 +1007,13 @@ void sclexer_print_tok(struct sclexer *self, struct sclexer_tok *tok)
 	case SCLEXER_KEYWORD:
 		printf(_SCLEXER_TOK_KIND_FMT"('%s', "_SCLEXER_TOK_LOC_FMT")\n",
 				_SCLEXER_TOK_KIND_FMT_ARG(tok),
-				self->keywords[tok->data.keyword],
+				self->cfg->keywords[tok->data.keyword],
 				_SCLEXER_TOK_LOC_UNWRAP(tok));
 		break;
 	case SCLEXER_SYMBOL:
 		printf(_SCLEXER_TOK_KIND_FMT"('%s', "_SCLEXER_TOK_LOC_FMT")\n",
 				_SCLEXER_TOK_KIND_FMT_ARG(tok),
-				self->symbols[tok->data.symbol],
+				self->cfg->symbols[tok->data.symbol],
 				_SCLEXER_TOK_LOC_UNWRAP(tok));
 		break;
 	default:
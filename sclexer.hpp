@@ -0,0 +1,802 @@
+/* C++ wrapper of sclexer.h (C++20)
+ *
+ * Usage:
+ *     * Compile 'sclexer.h' with 'SCLEXER_IMPL' in a C file,
+ *       the implementation can't be compiled as C++.
+ *     * 'scl::Lexer<>' takes options at runtime, it owns the source
+ *       and the option tables, so it can be moved but not copied.
+ *       'reset' parses another source without building the config again.
+ *     * 'scl::Lexer<Spec>' takes options from 'Spec' at compile time,
+ *       the symbol trie and the keyword hash are built by the compiler:
+ *
+ *           struct lisp_spec {
+ *                   static constexpr std::array comments{";"};
+ *                   static constexpr std::array keywords{"print"};
+ *                   static constexpr std::array symbols{"(", ")", "+"};
+ *                   static constexpr bool enable_indent = true;
+ *           };
+ *
+ *       'comments', 'keywords' and 'symbols' are required,
+ *       use 'std::array<const char *, 0>' for an empty one.
+ *       'enable_indent', 'skip_kinds', 'keep_dup_eol' and
+ *       'static bool is_ident(char c, bool begin)' are optional.
+ *     * Both of them are input ranges of 'sclexer_tok':
+ *
+ *           for (const sclexer_tok &tok : lexer)
+ *                   lexer.print(tok);
+ *
+ *       and give the same tokens as 'sclexer_get_tok' with same options.
+ *
+ * See 'sclexer.h' for the license. */
+#ifndef SCLEXER_HPP
+#define SCLEXER_HPP
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "sclexer.h"
+
+namespace scl {
+
+/* Single pass iterator, 'L' needs 'bool next(sclexer_tok &)'. */
+template <typename L>
+class token_iterator {
+public:
+	using iterator_concept = std::input_iterator_tag;
+	using value_type       = sclexer_tok;
+	using difference_type  = std::ptrdiff_t;
+	using reference        = const sclexer_tok &;
+
+	token_iterator() = default;
+	explicit token_iterator(L &lexer) : lexer_(&lexer) { ++*this; }
+
+	reference operator*() const { return tok_; }
+	const sclexer_tok *operator->() const { return &tok_; }
+
+	token_iterator &operator++()
+	{
+		if (!lexer_->next(tok_))
+			lexer_ = nullptr;
+		return *this;
+	}
+	void operator++(int) { ++*this; }
+
+	friend bool operator==(const token_iterator &it, std::default_sentinel_t)
+	{
+		return it.lexer_ == nullptr;
+	}
+
+private:
+	L *lexer_ = nullptr;
+	sclexer_tok tok_{};
+};
+
+/* Runtime options of 'Lexer<>', same as 'struct sclexer_config'. */
+struct options {
+	std::vector<std::string> comments;
+	std::vector<std::string> keywords;
+	std::vector<std::string> symbols;
+
+	bool enable_indent = false;
+	bool (*is_ident)(char c, bool begin) = nullptr;
+	uint32_t skip_kinds = 0;
+	bool keep_dup_eol = false;
+};
+
+inline const char *kind_name(SCLEXER_TOK_KIND kind)
+{
+	return sclexer_kind_names(kind);
+}
+
+template <typename Spec = void>
+class Lexer;
+
+/* Runtime lexer, just drives 'sclexer_get_tok'. */
+template <>
+class Lexer<void> {
+public:
+	Lexer(options opts, std::string src, std::string fpath = "")
+		: s_(std::make_unique<state>())
+	{
+		s_->opts = std::move(opts);
+		s_->src = std::move(src);
+		s_->fpath = std::move(fpath);
+		to_cstrs(s_->comments, s_->opts.comments);
+		to_cstrs(s_->keywords, s_->opts.keywords);
+		to_cstrs(s_->symbols, s_->opts.symbols);
+
+		sclexer_config &cfg = s_->cfg;
+		cfg.enable_indent = s_->opts.enable_indent;
+		cfg.is_ident = s_->opts.is_ident;
+		cfg.comments = s_->comments.data();
+		cfg.comments_count = s_->comments.size();
+		cfg.keywords = s_->keywords.data();
+		cfg.keywords_count = s_->keywords.size();
+		cfg.symbols = s_->symbols.data();
+		cfg.symbols_count = s_->symbols.size();
+		cfg.skip_kinds = s_->opts.skip_kinds;
+		cfg.keep_dup_eol = s_->opts.keep_dup_eol;
+		sclexer_config_init(&cfg);
+
+		s_->lexer.cfg = &cfg;
+		s_->lexer.src = s_->src.c_str();
+		s_->lexer.src_siz = s_->src.size();
+		sclexer_init(&s_->lexer, s_->fpath.c_str());
+	}
+
+	Lexer(const Lexer &) = delete;
+	Lexer &operator=(const Lexer &) = delete;
+	Lexer(Lexer &&) noexcept = default;
+	Lexer &operator=(Lexer &&) noexcept = default;
+
+	/* Tokens of previous source are invalid after it,
+	 * the memory of previous source is reused when it's large enough.
+	 */
+	void reset(std::string_view src, std::string_view fpath = "")
+	{
+		s_->src.assign(src);
+		s_->fpath.assign(fpath);
+		s_->tokens.reset();
+		sclexer_reset(&s_->lexer, s_->src.c_str(), s_->src.size(),
+				s_->fpath.c_str());
+	}
+
+	bool next(sclexer_tok &tok) { return sclexer_get_tok(&s_->lexer, &tok); }
+
+	token_iterator<Lexer> begin() { return token_iterator<Lexer>(*this); }
+	std::default_sentinel_t end() const { return {}; }
+
+	/**
+	 * Lex all remaining tokens by 'sclexer_get_tokens',
+	 * the result is owned by the lexer and lives until next call of it.
+	 */
+	std::span<const sclexer_tok> tokens()
+	{
+		sclexer_tok *tokens = nullptr;
+		size_t count = sclexer_get_tokens(&s_->lexer, &tokens);
+		s_->tokens.reset(tokens);
+		return {tokens, count};
+	}
+
+	void print(const sclexer_tok &tok)
+	{
+		sclexer_print_tok(&s_->lexer, const_cast<sclexer_tok *>(&tok));
+	}
+
+	/* See 'sclexer_estimate_tokens'. */
+	size_t estimate(sclexer_stats *result = nullptr) const
+	{
+		return sclexer_estimate_tokens(&s_->lexer, result);
+	}
+
+	const sclexer_stats &stats() const { return s_->lexer.stats; }
+
+	sclexer *get() { return &s_->lexer; }
+
+private:
+	struct free_deleter {
+		void operator()(void *p) const { std::free(p); }
+	};
+
+	/* 'struct sclexer' points into all of them, keep their address. */
+	struct state {
+		options opts;
+		std::string src, fpath;
+		std::vector<const char *> comments, keywords, symbols;
+		std::unique_ptr<sclexer_tok[], free_deleter> tokens;
+		sclexer_config cfg{};
+		sclexer lexer{};
+	};
+
+	static void to_cstrs(std::vector<const char *> &dst,
+			const std::vector<std::string> &src)
+	{
+		dst.reserve(src.size());
+		for (const std::string &s : src)
+			dst.push_back(s.c_str());
+	}
+
+	std::unique_ptr<state> s_;
+};
+
+namespace detail {
+
+/* Same as the "C" locale of <ctype.h>. */
+constexpr bool is_space(char c)
+{
+	return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+constexpr bool is_digit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+constexpr bool default_is_ident(char c, bool begin)
+{
+	if (is_digit(c))
+		return !begin;
+	return c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+constexpr size_t cstr_len(const char *s)
+{
+	size_t n = 0;
+	while (s[n] != '\0')
+		n++;
+	return n;
+}
+
+constexpr bool cstr_eq(const char *a, const char *b)
+{
+	for (; *a != '\0' && *a == *b; a++, b++)
+		;
+	return *a == *b;
+}
+
+/* Same as '_sclexer_cmp_src_with_cstr'. */
+constexpr size_t cmp_src_with_cstr(const char *cur, const char *cstr)
+{
+	size_t i = 0;
+	for (; cur[i] != '\0' && cstr[i] != '\0'; i++) {
+		if (cur[i] != cstr[i])
+			return 0;
+	}
+	if (cstr[i] != '\0')
+		return 0;
+	return i;
+}
+
+template <typename Spec>
+constexpr bool spec_enable_indent()
+{
+	if constexpr (requires { Spec::enable_indent; })
+		return Spec::enable_indent;
+	return false;
+}
+
+template <typename Spec>
+constexpr uint32_t spec_skip_kinds()
+{
+	if constexpr (requires { Spec::skip_kinds; })
+		return Spec::skip_kinds;
+	return 0;
+}
+
+template <typename Spec>
+constexpr bool spec_keep_dup_eol()
+{
+	if constexpr (requires { Spec::keep_dup_eol; })
+		return Spec::keep_dup_eol;
+	return false;
+}
+
+template <typename Spec>
+inline bool spec_is_ident(char c, bool begin)
+{
+	if constexpr (requires { Spec::is_ident(c, begin); })
+		return Spec::is_ident(c, begin);
+	else
+		return default_is_ident(c, begin);
+}
+
+/* Longest match of the symbols, chars are mapped to classes
+ * to keep the transition table small, 0 is "no such class/node".
+ * Same as '_sclexer_try_symbol', the last one wins a tie.
+ */
+template <typename Spec>
+struct symbol_trie {
+	static constexpr size_t node_count()
+	{
+		size_t n = 1;
+		for (const char *s : Spec::symbols)
+			n += cstr_len(s);
+		return n;
+	}
+
+	static constexpr size_t class_count()
+	{
+		bool seen[256] = {};
+		size_t n = 1;
+		for (const char *s : Spec::symbols) {
+			for (; *s != '\0'; s++) {
+				if (seen[(unsigned char)*s])
+					continue;
+				seen[(unsigned char)*s] = true;
+				n++;
+			}
+		}
+		return n;
+	}
+
+	static constexpr size_t nodes = node_count();
+	static constexpr size_t classes = class_count();
+	static_assert(nodes <= UINT16_MAX, "too many symbols");
+
+	struct table {
+		std::array<uint8_t, 256> cls{};
+		std::array<uint16_t, nodes * classes> next{};
+		/* index of symbol + 1 */
+		std::array<size_t, nodes> sym{};
+	};
+
+	static constexpr table build()
+	{
+		table t{};
+		size_t cls_used = 1, nodes_used = 1;
+		for (size_t i = 0; i < Spec::symbols.size(); i++) {
+			const char *s = Spec::symbols[i];
+			size_t node = 0;
+			if (*s == '\0')
+				continue;
+			for (; *s != '\0'; s++) {
+				uint8_t &c = t.cls[(unsigned char)*s];
+				if (c == 0)
+					c = cls_used++;
+				uint16_t &next = t.next[node * classes + c];
+				if (next == 0)
+					next = nodes_used++;
+				node = next;
+			}
+			t.sym[node] = i + 1;
+		}
+		return t;
+	}
+
+	static constexpr table tab = build();
+
+	static size_t match(const char *cur, size_t &symbol)
+	{
+		size_t node = 0, readed = 0;
+		for (size_t i = 0; ; i++) {
+			uint8_t c = tab.cls[(unsigned char)cur[i]];
+			if (c == 0)
+				break;
+			node = tab.next[node * classes + c];
+			if (node == 0)
+				break;
+			if (tab.sym[node]) {
+				symbol = tab.sym[node] - 1;
+				readed = i + 1;
+			}
+		}
+		return readed;
+	}
+};
+
+/* Open addressing hash of the keywords, the first one wins
+ * duplicated keywords like '_sclexer_try_keyword'.
+ */
+template <typename Spec>
+struct keyword_hash {
+	static constexpr size_t size()
+	{
+		size_t n = 1;
+		while (n < Spec::keywords.size() * 2)
+			n <<= 1;
+		return n;
+	}
+
+	static constexpr size_t hash(const char *s, size_t len)
+	{
+		return (len * 31
+				+ (unsigned char)s[0] * 7
+				+ (unsigned char)s[len - 1]) & (size() - 1);
+	}
+
+	struct table {
+		/* index of keyword + 1 */
+		std::array<size_t, size()> slot{};
+		std::array<size_t, Spec::keywords.size()> len{};
+	};
+
+	static constexpr table build()
+	{
+		table t{};
+		for (size_t i = 0; i < Spec::keywords.size(); i++) {
+			const char *s = Spec::keywords[i];
+			size_t h;
+			bool dup = false;
+			t.len[i] = cstr_len(s);
+			if (t.len[i] == 0)
+				continue;
+			h = hash(s, t.len[i]);
+			for (; t.slot[h]; h = (h + 1) & (size() - 1)) {
+				if (cstr_eq(Spec::keywords[t.slot[h] - 1], s))
+					dup = true;
+			}
+			if (!dup)
+				t.slot[h] = i + 1;
+		}
+		return t;
+	}
+
+	static constexpr table tab = build();
+
+	static bool find(const char *s, size_t len, size_t &keyword)
+	{
+		size_t h = hash(s, len);
+		for (; tab.slot[h]; h = (h + 1) & (size() - 1)) {
+			size_t i = tab.slot[h] - 1;
+			if (tab.len[i] != len)
+				continue;
+			if (std::memcmp(Spec::keywords[i], s, len) != 0)
+				continue;
+			keyword = i;
+			return true;
+		}
+		return false;
+	}
+};
+
+} // namespace detail
+
+/* Compile-time lexer, a specialized copy of 'sclexer_get_tok'.
+ * It keeps the cursor in a 'struct sclexer' with a config shared by all
+ * 'Lexer<Spec>', so 'sclexer_print_tok' works.
+ */
+template <typename Spec>
+class Lexer {
+public:
+	static constexpr bool enable_indent = detail::spec_enable_indent<Spec>();
+	static constexpr uint32_t skip_kinds = detail::spec_skip_kinds<Spec>();
+	static constexpr bool keep_dup_eol = detail::spec_keep_dup_eol<Spec>();
+
+	explicit Lexer(std::string_view src, std::string_view fpath = "")
+	{
+		s_.cfg = cfg();
+		s_.skip_kinds = skip_kinds;
+		s_.keep_dup_eol = keep_dup_eol;
+		reset(src, fpath);
+	}
+
+	Lexer(const Lexer &) = delete;
+	Lexer &operator=(const Lexer &) = delete;
+	Lexer(Lexer &&) noexcept = default;
+	Lexer &operator=(Lexer &&) noexcept = default;
+
+	/* The buffer of previous source is reused when it's large enough. */
+	void reset(std::string_view src, std::string_view fpath = "")
+	{
+		size_t size = src.size() + fpath.size() + 2;
+		char *fp;
+		if (size > cap_ || in_buf(src) || in_buf(fpath)) {
+			/* 'src' may be a view of current source, copy it first */
+			std::unique_ptr<char[]> buf(new char[size]);
+			fp = store(buf.get(), src, fpath);
+			buf_ = std::move(buf);
+			cap_ = size;
+		} else {
+			fp = store(buf_.get(), src, fpath);
+		}
+
+		s_.src = buf_.get();
+		s_.src_siz = src.size();
+		s_.stats = {};
+		s_._after_endl = false;
+		s_._cur = s_.src;
+		s_._last_indent = 0;
+		s_._prev_kind = SCLEXER_UNKNOWN_TOK;
+		s_._loc.fpath = fp;
+		s_._loc.line = 1;
+		s_._loc.column = 1;
+	}
+
+	bool next(sclexer_tok &tok)
+	{
+		while (scan(tok)) {
+			if (is_skipped(tok.kind))
+				continue;
+			s_._prev_kind = tok.kind;
+			s_.stats.kinds[tok.kind]++;
+			s_.stats.tokens++;
+			s_.stats.bytes = tok.src.begin + tok.src.len - s_.src;
+			return true;
+		}
+		return false;
+	}
+
+	token_iterator<Lexer> begin() { return token_iterator<Lexer>(*this); }
+	std::default_sentinel_t end() const { return {}; }
+
+	std::vector<sclexer_tok> tokens()
+	{
+		std::vector<sclexer_tok> result;
+		sclexer_tok tok{};
+		result.reserve(sclexer_guess_tokens(&s_));
+		while (next(tok))
+			result.push_back(tok);
+		return result;
+	}
+
+	void print(const sclexer_tok &tok)
+	{
+		sclexer_print_tok(&s_, const_cast<sclexer_tok *>(&tok));
+	}
+
+	/* See 'sclexer_estimate_tokens'. */
+	size_t estimate(sclexer_stats *result = nullptr) const
+	{
+		return sclexer_estimate_tokens(&s_, result);
+	}
+
+	const sclexer_stats &stats() const { return s_.stats; }
+
+	sclexer *get() { return &s_; }
+
+private:
+	using symbols = detail::symbol_trie<Spec>;
+	using keywords = detail::keyword_hash<Spec>;
+
+	/* For 'sclexer_print_tok' and 'sclexer_estimate_tokens',
+	 * tokens are never parsed by it.
+	 */
+	static sclexer_config make_cfg()
+	{
+		sclexer_config cfg{};
+		cfg.enable_indent = enable_indent;
+		cfg.is_ident = detail::spec_is_ident<Spec>;
+		cfg.comments = const_cast<const char **>(Spec::comments.data());
+		cfg.comments_count = Spec::comments.size();
+		cfg.keywords = const_cast<const char **>(Spec::keywords.data());
+		cfg.keywords_count = Spec::keywords.size();
+		cfg.symbols = const_cast<const char **>(Spec::symbols.data());
+		cfg.symbols_count = Spec::symbols.size();
+		cfg.skip_kinds = skip_kinds;
+		cfg.keep_dup_eol = keep_dup_eol;
+		sclexer_config_init(&cfg);
+		return cfg;
+	}
+
+	static const sclexer_config *cfg()
+	{
+		static const sclexer_config cfg = make_cfg();
+		return &cfg;
+	}
+
+	bool in_buf(std::string_view v) const
+	{
+		std::less<const char *> lt;
+		return !lt(v.data(), buf_.get()) && lt(v.data(), buf_.get() + cap_);
+	}
+
+	/* Source and file path, both end with '\0', returns the file path. */
+	static char *store(char *dst, std::string_view src, std::string_view fpath)
+	{
+		char *fp = &dst[src.size() + 1];
+		std::memcpy(dst, src.data(), src.size());
+		dst[src.size()] = '\0';
+		std::memcpy(fp, fpath.data(), fpath.size());
+		fp[fpath.size()] = '\0';
+		return fp;
+	}
+
+	static constexpr bool skip_kind(SCLEXER_TOK_KIND kind)
+	{
+		return skip_kinds & SCLEXER_KIND_BIT(kind);
+	}
+
+	bool is_skipped(SCLEXER_TOK_KIND kind) const
+	{
+		if (skip_kinds & SCLEXER_KIND_BIT(kind))
+			return true;
+		if (!keep_dup_eol && kind == SCLEXER_EOL)
+			return s_._prev_kind == SCLEXER_EOL;
+		return false;
+	}
+
+	void advance(size_t readed)
+	{
+		s_._cur += readed;
+		s_._loc.column += readed;
+	}
+
+	void next_line()
+	{
+		s_._after_endl = true;
+		s_._loc.line++;
+		s_._loc.column = 1;
+	}
+
+	bool try_indent(sclexer_tok &tok)
+	{
+		size_t readed = 0;
+		if constexpr (!enable_indent)
+			return false;
+		if (!s_._after_endl)
+			return false;
+		while (s_._cur[readed] == '\t')
+			readed++;
+		if (readed > s_._last_indent) {
+			tok.kind = SCLEXER_INDENT_BLOCK_BEGIN;
+			s_._last_indent++;
+		} else if (readed < s_._last_indent) {
+			tok.kind = SCLEXER_INDENT_BLOCK_END;
+			s_._last_indent--;
+		} else {
+			return false;
+		}
+		return true;
+	}
+
+	size_t try_comment() const
+	{
+		const char *cur = s_._cur;
+		for (const char *comment : Spec::comments) {
+			if (!detail::cmp_src_with_cstr(cur, comment))
+				continue;
+			for (size_t readed = 0; cur[readed] != '\0'; readed++) {
+				if (cur[readed] == '\n')
+					return readed + 1;
+			}
+			return 0;
+		}
+		return 0;
+	}
+
+	bool try_endl(sclexer_tok &tok)
+	{
+		size_t readed = 1;
+		if (s_._cur[0] != '\n' && (readed = try_comment()) == 0)
+			return false;
+		tok.kind = SCLEXER_EOL;
+		tok.src.len = readed;
+		advance(readed);
+		next_line();
+		return true;
+	}
+
+	/* Same as '_sclexer_try_digit', the '-' branch is dead in both,
+	 * '-' is not a digit, so 'SCLEXER_INT_NEG' is never returned.
+	 */
+	size_t try_digit(sclexer_tok &tok) const
+	{
+		size_t readed = 0;
+		tok.data.uint = 0;
+		if (s_._cur[0] == '-') {
+			if (!detail::is_digit(s_._cur[1]))
+				return 0;
+			readed = 1;
+		}
+		if (!detail::is_digit(s_._cur[0]))
+			return 0;
+		for (; detail::is_digit(s_._cur[readed]); readed++) {
+			tok.data.uint *= 10;
+			tok.data.uint += s_._cur[readed] - '0';
+		}
+		tok.kind = SCLEXER_INT;
+		if (s_._cur[0] == '-') {
+			tok.data.sint = -(tok.data.uint);
+			tok.kind = SCLEXER_INT_NEG;
+		}
+		return readed;
+	}
+
+	size_t try_string(sclexer_tok &tok) const
+	{
+		size_t readed = 1;
+		if (s_._cur[0] != '"')
+			return 0;
+		for (; s_._cur[readed] != '"'; readed++) {
+			if (s_._cur[readed] == '\0' || s_._cur[readed] == '\n')
+				return 0;
+		}
+		readed++;
+		tok.data.str.begin = &s_._cur[1];
+		tok.data.str.len = readed - 2;
+		tok.kind = SCLEXER_STRING;
+		return readed;
+	}
+
+	size_t try_symbol(sclexer_tok &tok) const
+	{
+		size_t readed = symbols::match(s_._cur, tok.data.symbol);
+		if (readed)
+			tok.kind = SCLEXER_SYMBOL;
+		return readed;
+	}
+
+	size_t do_ident(sclexer_tok &tok) const
+	{
+		size_t readed = 1;
+		if (!detail::spec_is_ident<Spec>(s_._cur[0], true))
+			return 0;
+		for (; s_._cur[readed] != '\0'; readed++) {
+			if (!detail::spec_is_ident<Spec>(s_._cur[readed], false))
+				break;
+		}
+		tok.kind = SCLEXER_IDENT;
+		tok.data.str.begin = tok.src.begin;
+		tok.data.str.len = readed;
+		if constexpr (skip_kind(SCLEXER_IDENT) && skip_kind(SCLEXER_KEYWORD))
+			return readed;
+		if (keywords::find(tok.src.begin, readed, tok.data.keyword))
+			tok.kind = SCLEXER_KEYWORD;
+		return readed;
+	}
+
+	bool scan(sclexer_tok &tok)
+	{
+		size_t readed = 0;
+		tok.src.begin = s_._cur;
+		tok.src.len = 0;
+		tok.loc = s_._loc;
+		tok.kind = SCLEXER_UNKNOWN_TOK;
+
+		if (try_indent(tok)) {
+			s_._after_endl = false;
+			return true;
+		}
+
+		if (s_._cur[0] == '\0') {
+			if (!s_._after_endl) {
+				tok.kind = SCLEXER_EOL;
+				s_._after_endl = true;
+				return true;
+			}
+			return false;
+		}
+		s_._after_endl = false;
+
+		if (s_._cur[0] != '\n') {
+			while (detail::is_space(s_._cur[readed]))
+				readed++;
+			advance(readed);
+		}
+		if (s_._cur[0] == '\0') {
+			if (s_._last_indent) {
+				tok.kind = SCLEXER_INDENT_BLOCK_END;
+				s_._last_indent--;
+				return true;
+			}
+			tok.kind = SCLEXER_EOF;
+			return false;
+		}
+
+		tok.src.begin = s_._cur;
+		tok.loc = s_._loc;
+
+		if (try_endl(tok))
+			return true;
+		if ((readed = try_digit(tok)))
+			goto end;
+		if ((readed = try_string(tok)))
+			goto end;
+		if ((readed = try_symbol(tok)))
+			goto end;
+		if ((readed = do_ident(tok)))
+			goto end;
+		std::fprintf(stderr, _SCLEXER_ERR_FMT "unknown token '%c' "
+				_SCLEXER_TOK_LOC_FMT "\n",
+				_SCLEXER_ERR_FMT_ARG,
+				s_._cur[0],
+				_SCLEXER_TOK_LOC_UNWRAP(&tok));
+		std::exit(EXIT_FAILURE);
+	end:
+		advance(readed);
+		tok.src.len = readed;
+		return true;
+	}
+
+	std::unique_ptr<char[]> buf_;
+	size_t cap_ = 0;
+	sclexer s_{};
+};
+
+static_assert(std::ranges::input_range<Lexer<>>);
+
+} // namespace scl
+
+#endif